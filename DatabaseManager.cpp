@@ -9,6 +9,16 @@ DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent)
 {
 }
 
+QString DatabaseManager::driverName(DatabaseType type)
+{
+    return type == PostgreSQL ? "QPSQL" : "QSQLITE";
+}
+
+QString DatabaseManager::postgreSQLConnectOptions()
+{
+    return QString("connect_timeout=%1").arg(ConnectTimeoutSeconds);
+}
+
 DatabaseManager::~DatabaseManager()
 {
     auto connections = m_connections.keys();
@@ -24,7 +34,8 @@ bool DatabaseManager::connectToDatabase(DatabaseType type, const QString &connec
                                      const QString &password,
                                      int port)
 {
-    if (m_connections.contains(connectionName)) {
+    // Имя может быть занято и соединением, которое восстанавливается в фоне
+    if (m_connections.contains(connectionName) || QSqlDatabase::contains(connectionName)) {
         m_lastError = "Connection with this name already exists";
         return false;
     }
@@ -37,18 +48,27 @@ bool DatabaseManager::connectToDatabase(DatabaseType type, const QString &connec
         }
     }
 
+    // Драйвер проверяется только при подключении, а не при старте приложения
+    QString driver = driverName(type);
+    if (!QSqlDatabase::isDriverAvailable(driver)) {
+        m_lastError = "Driver not available: " + driver
+                      + " (available: " + QSqlDatabase::drivers().join(", ") + ")";
+        return false;
+    }
+
     QSqlDatabase db;
     if (type == SQLite) {
-        db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db = QSqlDatabase::addDatabase(driver, connectionName);
         db.setDatabaseName(databaseName);
     } 
     else if (type == PostgreSQL) {
-        db = QSqlDatabase::addDatabase("QPSQL", connectionName);
+        db = QSqlDatabase::addDatabase(driver, connectionName);
         db.setDatabaseName(databaseName);
         db.setHostName(host);
         db.setUserName(user);
         db.setPassword(password);
         if (port > 0) db.setPort(port);
+        db.setConnectOptions(postgreSQLConnectOptions());
     }
 
     if (!db.open()) {
@@ -62,6 +82,25 @@ bool DatabaseManager::connectToDatabase(DatabaseType type, const QString &connec
     return true;
 }
 
+// Регистрирует соединение, открытое в другом потоке и переданное этому
+bool DatabaseManager::adoptConnection(const QString &connectionName)
+{
+    if (m_connections.contains(connectionName)) {
+        m_lastError = "Connection with this name already exists";
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+    if (!db.isValid() || !db.isOpen()) {
+        m_lastError = "Connection not found: " + connectionName;
+        return false;
+    }
+
+    m_connections[connectionName] = db;
+    m_tablesCache.remove(connectionName);
+    return true;
+}
+
 void DatabaseManager::disconnectFromDatabase(const QString &connectionName)
 {
     if (m_connections.contains(connectionName)) {
@@ -149,6 +188,13 @@ QStringList DatabaseManager::activeConnections() const
     return m_connections.keys();
 }
 
+void DatabaseManager::primeTablesCache(const QString &connectionName, const QStringList &tables)
+{
+    if (m_connections.contains(connectionName)) {
+        m_tablesCache[connectionName] = tables;
+    }
+}
+
 QString DatabaseManager::lastError() const
 {
     return m_lastError;
@@ -15,6 +15,12 @@ public:
     explicit DatabaseManager(QObject *parent = nullptr);
     ~DatabaseManager();
 
+    // Ограничение на установку соединения с PostgreSQL, в секундах
+    static const int ConnectTimeoutSeconds = 5;
+
+    static QString driverName(DatabaseType type);
+    static QString postgreSQLConnectOptions();
+
     bool connectToDatabase(DatabaseType type, const QString &connectionName,
                          const QString &databaseName,
                          const QString &host = "",
@@ -22,11 +28,13 @@ public:
                          const QString &password = "",
                          int port = -1);
 
+    bool adoptConnection(const QString &connectionName);
     void disconnectFromDatabase(const QString &connectionName);
     QSqlQuery executeQuery(const QString &query, const QString &connectionName);
     QStringList getTables(const QString &connectionName);
     QStringList getTableColumns(const QString &tableName, const QString &connectionName);
     QStringList activeConnections() const;
+    void primeTablesCache(const QString &connectionName, const QStringList &tables);
     QString lastError() const;
 
     bool beginTransaction(const QString &connectionName);
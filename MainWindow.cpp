@@ -9,6 +9,13 @@
 #include <QListWidgetItem>
 #include <QSqlError>
 #include <QDebug>
+#include <QTableWidgetItem>
+#include <QProgressBar>
+#include <QThread>
+#include <QTimer>
+#include <QInputDialog>
+#include <QSignalBlocker>
+#include <QFileInfo>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -40,6 +47,7 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->btnClearHistory, &QPushButton::clicked, [this]() {
         m_queryHistory.clear();
         ui->listQueryHistory->clear();
+        m_historyCleared = !m_historyLoaded;  // Загруженная позже история не должна вернуться
         saveHistory();
     });
     connect(ui->listQueryHistory, &QListWidget::itemClicked, [this](QListWidgetItem *item) {
@@ -47,19 +55,183 @@ MainWindow::MainWindow(QWidget *parent) :
     });
     // Соединение для кнопки "Обзор"
 connect(ui->btnBrowse, &QPushButton::clicked, this, &MainWindow::onBrowseClicked);
+    connect(ui->btnCompare, &QPushButton::clicked, this, &MainWindow::onCompareResults);
+    connect(ui->btnCancelCompare, &QPushButton::clicked, [this]() {
+        if (m_comparator) m_comparator->cancel();
+    });
 
-    // Загрузка истории
-    loadHistory();
-    for (const QString &query : m_queryHistory) {
-        ui->listQueryHistory->addItem(query);
-    }
+    // История и сохранённые подключения загружаются в фоне после первой отрисовки
+    m_startupProgress = new QProgressBar(this);
+    m_startupProgress->setMaximumWidth(200);
+    m_startupProgress->setVisible(false);
+    ui->statusbar->addPermanentWidget(m_startupProgress);
 }
 
 MainWindow::~MainWindow()
 {
+    if (m_compareThread) {
+        m_comparator->cancel();
+        m_compareThread->quit();
+        m_compareThread->wait();
+    }
+    if (m_restoreThread) {
+        // Новые подключения больше не запрашиваются, а уже поставленные в очередь
+        // openProfile пропускает; ждать приходится не дольше connect_timeout
+        disconnect(this, &MainWindow::restoreRequested, nullptr, nullptr);
+        m_restoreThread->requestInterruption();
+        m_restoreThread->quit();
+        m_restoreThread->wait();
+    }
     delete ui;
 }
 
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+
+    if (!m_firstPaintDone) {
+        m_firstPaintDone = true;
+        emit firstPainted();
+        QTimer::singleShot(0, this, &MainWindow::restoreSession);
+    }
+}
+
+void MainWindow::restoreSession()
+{
+    if (m_restoreThread) return;
+
+    qRegisterMetaType<ConnectionProfile>();
+    qRegisterMetaType<QList<ConnectionProfile>>();
+
+    m_restoreThread = new QThread(this);
+    SessionRestorer *restorer = new SessionRestorer;
+    restorer->moveToThread(m_restoreThread);
+
+    connect(m_restoreThread, &QThread::started, restorer, &SessionRestorer::run);
+    connect(restorer, &SessionRestorer::historyLoaded, this, &MainWindow::onHistoryLoaded);
+    connect(restorer, &SessionRestorer::profilesLoaded, this, &MainWindow::onProfilesLoaded);
+    connect(restorer, &SessionRestorer::profileRestored, this, &MainWindow::onProfileRestored);
+    connect(this, &MainWindow::restoreRequested, restorer, &SessionRestorer::openProfile);
+    // Поток живёт до закрытия окна: в нём же открываются профили с паролем
+    connect(m_restoreThread, &QThread::finished, restorer, &QObject::deleteLater);
+
+    m_startupProgress->setRange(0, 0);
+    m_startupProgress->setVisible(true);
+    ui->statusbar->showMessage("Restoring session...");
+    m_restoreThread->start();
+}
+
+void MainWindow::onHistoryLoaded(const QStringList &history)
+{
+    // Запросы, выполненные до окончания загрузки, остаются сверху;
+    // если историю успели очистить, сохранённая отбрасывается
+    QList<QString> loaded = m_queryHistory;
+    if (!m_historyCleared) {
+        for (const QString &query : history) {
+            if (!loaded.contains(query)) loaded.append(query);
+        }
+    }
+    while (loaded.size() > 50) loaded.removeLast();
+
+    m_queryHistory = loaded;
+    m_historyLoaded = true;
+
+    ui->listQueryHistory->clear();
+    ui->listQueryHistory->addItems(m_queryHistory);
+
+    if (m_queryHistory != history) saveHistory();
+}
+
+void MainWindow::onProfilesLoaded(const QList<ConnectionProfile> &profiles)
+{
+    // Имена резервируются здесь, в потоке окна, до открытия в фоне:
+    // ручное подключение с тем же именем будет отклонено
+    for (const ConnectionProfile &profile : profiles) {
+        if (dbManager->activeConnections().contains(profile.name)
+            || QSqlDatabase::contains(profile.name)
+            || m_restoringNames.contains(profile.name)) {
+            continue;
+        }
+        m_restoringNames.insert(profile.name);
+
+        // Без пароля подключение заведомо не удастся — спросим после фоновой части
+        if (profile.needsPassword) {
+            m_passwordProfiles.append(profile);
+        } else {
+            ++m_pendingRestores;
+            emit restoreRequested(profile, QString());
+        }
+    }
+
+    m_startupProgress->setRange(0, m_pendingRestores);
+    m_startupProgress->setValue(0);
+    if (m_pendingRestores == 0) onSessionRestored();
+}
+
+void MainWindow::onProfileRestored(const ConnectionProfile &profile, bool success,
+                                   const QStringList &tables, const QString &error)
+{
+    if (success) {
+        // Соединение открыто в фоновом потоке и уже передано потоку окна
+        if (dbManager->adoptConnection(profile.name)) {
+            dbManager->primeTablesCache(profile.name, tables);
+            updateConnectionsList();
+            if (profile.needsPassword) {
+                ui->statusbar->showMessage("Restored " + profile.name, 3000);
+            }
+        } else {
+            QSqlDatabase::removeDatabase(profile.name);
+            ui->statusbar->showMessage("Failed to restore " + profile.name + ": "
+                                       + dbManager->lastError(), 5000);
+        }
+        m_restoringNames.remove(profile.name);
+    } else if (profile.needsPassword) {
+        // Скорее всего неверный пароль — спрашиваем ещё раз, имя остаётся занятым
+        requestPassword(profile, error);
+    } else {
+        ui->statusbar->showMessage("Failed to restore " + profile.name + ": " + error, 5000);
+        m_restoringNames.remove(profile.name);
+    }
+
+    if (!profile.needsPassword) {
+        m_startupProgress->setValue(m_startupProgress->value() + 1);
+        if (--m_pendingRestores == 0) onSessionRestored();
+    }
+}
+
+void MainWindow::onSessionRestored()
+{
+    m_startupProgress->setVisible(false);
+    if (ui->statusbar->currentMessage() == "Restoring session...") {
+        ui->statusbar->showMessage("Session restored", 3000);
+    }
+
+    // Пароли спрашиваются после фоновой части, чтобы не прерывать её диалогами
+    QList<ConnectionProfile> profiles = m_passwordProfiles;
+    m_passwordProfiles.clear();
+    for (const ConnectionProfile &profile : profiles) {
+        requestPassword(profile, QString());
+    }
+}
+
+void MainWindow::requestPassword(const ConnectionProfile &profile, const QString &error)
+{
+    QString label = QString("Password for %1 (%2@%3):")
+                        .arg(profile.name, profile.user, profile.host);
+    if (!error.isEmpty()) label = error + "\n\n" + label;
+
+    bool ok = false;
+    QString password = QInputDialog::getText(this, "Restore connection", label,
+                                             QLineEdit::Password, QString(), &ok);
+    if (!ok) {
+        m_restoringNames.remove(profile.name);
+        return;
+    }
+
+    ui->statusbar->showMessage("Restoring " + profile.name + "...");
+    emit restoreRequested(profile, password);
+}
+
 void MainWindow::onConnectToDatabase()
 {
     DatabaseManager::DatabaseType dbType = ui->rbSQLite->isChecked() ? 
@@ -72,22 +244,34 @@ void MainWindow::onConnectToDatabase()
         return;
     }
     
-    bool success = false;
+    if (m_restoringNames.contains(connectionName)) {
+        showError("Connection is being restored: " + connectionName);
+        return;
+    }
+    
+    ConnectionProfile profile;
+    profile.type = dbType;
+    profile.name = connectionName;
+    QString password;
     if (dbType == DatabaseManager::SQLite) {
+        // Абсолютный путь, чтобы профиль восстанавливался из любого рабочего каталога
         QString dbPath = ui->leSQLitePath->text().trimmed();
-        success = dbManager->connectToDatabase(dbType, connectionName, dbPath);
+        profile.databaseName = dbPath.isEmpty() ? dbPath : QFileInfo(dbPath).absoluteFilePath();
     } else {
-        QString dbName = ui->lePGDatabase->text().trimmed();
-        QString host = ui->lePGHost->text().trimmed();
-        QString user = ui->lePGUser->text().trimmed();
-        QString password = ui->lePGPassword->text().trimmed();
-        int port = ui->sbPGPort->value();
-        
-        success = dbManager->connectToDatabase(dbType, connectionName, dbName, 
-                                             host, user, password, port);
+        profile.databaseName = ui->lePGDatabase->text().trimmed();
+        profile.host = ui->lePGHost->text().trimmed();
+        profile.user = ui->lePGUser->text().trimmed();
+        profile.port = ui->sbPGPort->value();
+        password = ui->lePGPassword->text().trimmed();
+        profile.needsPassword = !password.isEmpty();
     }
     
+    bool success = dbManager->connectToDatabase(dbType, connectionName, profile.databaseName,
+                                                profile.host, profile.user, password, profile.port);
+    
     if (success) {
+        saveProfile(profile);
+
         updateConnectionsList();
         QMessageBox::information(this, "Success", "Connected successfully");
     } else {
@@ -101,6 +285,7 @@ void MainWindow::onDisconnectFromDatabase()
     if (connectionName.isEmpty()) return;
     
     dbManager->disconnectFromDatabase(connectionName);
+    removeProfile(connectionName);
     updateConnectionsList();
 }
 
@@ -205,29 +390,67 @@ void MainWindow::saveToHistory(const QString &query)
     if (m_queryHistory.size() > 50) m_queryHistory.removeLast();
     
     ui->listQueryHistory->clear();
-    for (const QString &q : m_queryHistory) {
-        ui->listQueryHistory->addItem(q);
-    }
+    ui->listQueryHistory->addItems(m_queryHistory);
     
     saveHistory();
 }
 
-void MainWindow::loadHistory()
+void MainWindow::saveHistory()
 {
+    // До загрузки сохранённой истории запись затёрла бы её
+    if (!m_historyLoaded) return;
+
     QSettings settings;
-    m_queryHistory = settings.value("queryHistory").toStringList();
+    settings.setValue("queryHistory", m_queryHistory);
 }
 
-void MainWindow::saveHistory()
+void MainWindow::saveProfile(const ConnectionProfile &profile)
 {
-    QSettings settings;
-    settings.setValue("queryHistory", m_queryHistory);
+    QList<ConnectionProfile> profiles = SessionRestorer::loadProfiles();
+    for (int i = 0; i < profiles.size(); ++i) {
+        if (profiles.at(i).name == profile.name) {
+            profiles.removeAt(i);
+            break;
+        }
+    }
+    profiles.append(profile);
+    SessionRestorer::saveProfiles(profiles);
+}
+
+void MainWindow::removeProfile(const QString &connectionName)
+{
+    QList<ConnectionProfile> profiles = SessionRestorer::loadProfiles();
+    for (int i = 0; i < profiles.size(); ++i) {
+        if (profiles.at(i).name == connectionName) {
+            profiles.removeAt(i);
+            SessionRestorer::saveProfiles(profiles);
+            return;
+        }
+    }
 }
 
 void MainWindow::updateConnectionsList()
 {
-    ui->cbConnections->clear();
-    ui->cbConnections->addItems(dbManager->activeConnections());
+    QStringList connections = dbManager->activeConnections();
+    QString current = ui->cbConnections->currentText();
+
+    // Выбор пользователя сохраняется: список обновляется и при фоновом восстановлении
+    for (QComboBox *combo : {ui->cbConnections, ui->cbCompareLeft, ui->cbCompareRight}) {
+        QString selected = combo->currentText();
+        QSignalBlocker blocker(combo);
+        combo->clear();
+        combo->addItems(connections);
+        int index = combo->findText(selected);
+        if (index >= 0) combo->setCurrentIndex(index);
+    }
+
+    if (ui->cbConnections->currentText() != current) {
+        if (ui->cbConnections->currentIndex() >= 0) {
+            onConnectionSelected(ui->cbConnections->currentIndex());
+        } else {
+            ui->cbTables->clear();
+        }
+    }
 }
 
 void MainWindow::updateTablesList(const QString &connectionName)
@@ -247,6 +470,154 @@ void MainWindow::updateQueryResults(QSqlQuery query)
     }
 }
 
+void MainWindow::onCompareResults()
+{
+    QString leftConnection = ui->cbCompareLeft->currentText();
+    QString rightConnection = ui->cbCompareRight->currentText();
+    if (leftConnection.isEmpty() || rightConnection.isEmpty()) {
+        showError("No connection selected");
+        return;
+    }
+
+    QString leftQuery = ui->pteCompareLeft->toPlainText().trimmed();
+    QString rightQuery = ui->pteCompareRight->toPlainText().trimmed();
+    if (rightQuery.isEmpty()) rightQuery = leftQuery;  // Один запрос на оба соединения
+    if (leftQuery.isEmpty()) {
+        showError("Query is empty");
+        return;
+    }
+
+    QStringList keyColumns;
+    for (const QString &column : ui->leCompareKeys->text().split(',', Qt::SkipEmptyParts)) {
+        keyColumns << column.trimmed();
+    }
+
+    if (m_compareThread) return;
+
+    qRegisterMetaType<CompareResult>();
+
+    // Сравнение идёт в своём потоке на клонах соединений
+    m_compareThread = new QThread(this);
+    m_comparator = new ResultComparator;
+    m_comparator->moveToThread(m_compareThread);
+
+    ResultComparator *comparator = m_comparator;
+    connect(m_compareThread, &QThread::started, comparator,
+            [comparator, leftQuery, leftConnection, rightQuery, rightConnection, keyColumns]() {
+        comparator->run(leftQuery, leftConnection, rightQuery, rightConnection, keyColumns);
+    });
+    connect(comparator, &ResultComparator::progress, this, [this](qint64 leftRows, qint64 rightRows) {
+        ui->statusbar->showMessage(QString("Comparing: %1 / %2 rows").arg(leftRows).arg(rightRows));
+    });
+    connect(comparator, &ResultComparator::bucketProgress, this, [this](int done, int total) {
+        ui->statusbar->showMessage(QString("Comparing buckets: %1 / %2").arg(done).arg(total));
+    });
+    connect(comparator, &ResultComparator::finished, this, &MainWindow::onCompareFinished);
+    connect(m_compareThread, &QThread::finished, comparator, &QObject::deleteLater);
+    connect(m_compareThread, &QThread::finished, m_compareThread, &QObject::deleteLater);
+
+    setCompareRunning(true);
+    m_compareThread->start();
+}
+
+void MainWindow::onCompareFinished(bool success, const CompareResult &result, const QString &error)
+{
+    bool cancelled = m_comparator->isCancelled();
+
+    // Поток и сравниватель удалятся сами после остановки потока
+    m_compareThread->quit();
+    m_compareThread = nullptr;
+    m_comparator = nullptr;
+    setCompareRunning(false);
+    ui->statusbar->clearMessage();
+
+    if (success) {
+        showCompareResult(result);
+    } else if (cancelled) {
+        ui->statusbar->showMessage("Comparison cancelled", 3000);
+    } else {
+        showError(error);
+    }
+}
+
+void MainWindow::setCompareRunning(bool running)
+{
+    ui->btnCompare->setEnabled(!running);
+    ui->btnCancelCompare->setEnabled(running);
+}
+
+void MainWindow::showCompareResult(const CompareResult &result)
+{
+    ui->lblCompareSummary->setText(
+        QString("Rows: %1 / %2. Added: %3, removed: %4, changed: %5. "
+                "Buckets skipped: %6, compared: %7.%8")
+            .arg(result.leftRows).arg(result.rightRows)
+            .arg(result.added).arg(result.removed).arg(result.changed)
+            .arg(result.bucketsSkipped).arg(result.bucketsCompared)
+            .arg(result.truncated ? " (list truncated)" : ""));
+
+    // Колонки, которые есть только с одной стороны, и предупреждения сравнения
+    QStringList schemaNotes;
+    if (!result.leftOnlyColumns.isEmpty()) {
+        schemaNotes << "Only in left: " + result.leftOnlyColumns.join(", ");
+    }
+    if (!result.rightOnlyColumns.isEmpty()) {
+        schemaNotes << "Only in right: " + result.rightOnlyColumns.join(", ");
+    }
+    schemaNotes << result.warnings;
+    if (!schemaNotes.isEmpty()) {
+        ui->lblCompareSummary->setText(ui->lblCompareSummary->text() + "\n"
+                                       + schemaNotes.join(". ") + ".");
+    }
+
+    auto valueText = [](const QVariant &value) {
+        return value.isValid() ? value.toString() : QString("NULL");
+    };
+    auto rowText = [&valueText](const QVariantList &values) {
+        QStringList parts;
+        for (const QVariant &value : values) parts << valueText(value);
+        return parts.join(", ");
+    };
+
+    QTableWidget *table = ui->twCompareResults;
+    table->clear();
+    table->setRowCount(0);
+    table->setColumnCount(5);
+    table->setHorizontalHeaderLabels({"Status", "Key", "Column", "Left", "Right"});
+
+    auto addRow = [table](const QString &status, const QString &key, const QString &column,
+                          const QString &left, const QString &right) {
+        int row = table->rowCount();
+        table->insertRow(row);
+        table->setItem(row, 0, new QTableWidgetItem(status));
+        table->setItem(row, 1, new QTableWidgetItem(key));
+        table->setItem(row, 2, new QTableWidgetItem(column));
+        table->setItem(row, 3, new QTableWidgetItem(left));
+        table->setItem(row, 4, new QTableWidgetItem(right));
+    };
+
+    for (const RowDifference &difference : result.differences) {
+        switch (difference.kind) {
+        case RowDifference::Added:
+            addRow("Added", difference.key, QString(), QString(), rowText(difference.rightValues));
+            break;
+        case RowDifference::Removed:
+            addRow("Removed", difference.key, QString(), rowText(difference.leftValues), QString());
+            break;
+        case RowDifference::Changed:
+            // Отдельная строка на каждую отличающуюся колонку
+            for (const QString &column : difference.columns) {
+                int index = result.columns.indexOf(column);
+                addRow("Changed", difference.key, column,
+                       valueText(difference.leftValues.at(index)),
+                       valueText(difference.rightValues.at(index)));
+            }
+            break;
+        }
+    }
+    table->resizeColumnsToContents();
+}
+
 void MainWindow::onBrowseClicked() {
     QString filePath = QFileDialog::getOpenFileName(
         this,
@@ -3,7 +3,13 @@
 
 #include <QMainWindow>
 #include <QSqlQuery>
+#include <QSet>
 #include "DatabaseManager.h"
+#include "ResultComparator.h"
+#include "SessionRestorer.h"
+
+class QProgressBar;
+class QThread;
 
 namespace Ui {
 class MainWindow;
@@ -17,6 +23,13 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+signals:
+    void firstPainted();
+    void restoreRequested(const ConnectionProfile &profile, const QString &password);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
 private slots:
     void onConnectToDatabase();
     void onDisconnectFromDatabase();
@@ -28,17 +41,39 @@ private slots:
     void onOpenQueryBuilder();  // Новый слот
     void saveToHistory(const QString &query);  // Для истории запросов
     void onDatabaseTypeToggled(bool checked);  // Новый слот для переключения типа БД
+    void onCompareResults();  // Сравнение двух запросов/соединений
+    void onCompareFinished(bool success, const CompareResult &result, const QString &error);
+    void restoreSession();  // Фоновое восстановление после первой отрисовки
+    void onHistoryLoaded(const QStringList &history);
+    void onProfilesLoaded(const QList<ConnectionProfile> &profiles);
+    void onProfileRestored(const ConnectionProfile &profile, bool success,
+                           const QStringList &tables, const QString &error);
 
 private:
     void updateConnectionsList();
     void updateTablesList(const QString &connectionName);
     void updateQueryResults(QSqlQuery query);
     void showError(const QString &message);
-    void loadHistory();
     void saveHistory();
+    void saveProfile(const ConnectionProfile &profile);
+    void removeProfile(const QString &connectionName);
+    void onSessionRestored();
+    void requestPassword(const ConnectionProfile &profile, const QString &error);
     void togglePostgreSQLFields(bool show);  // ← ВАЖНО: добавили объявление здесь
+    void showCompareResult(const CompareResult &result);
+    void setCompareRunning(bool running);
 
     QList<QString> m_queryHistory;
+    bool m_historyLoaded = false;
+    bool m_historyCleared = false;  // Очищена до загрузки сохранённой истории
+    bool m_firstPaintDone = false;
+    QThread *m_restoreThread = nullptr;
+    QProgressBar *m_startupProgress = nullptr;
+    QList<ConnectionProfile> m_passwordProfiles;  // Ждут ввода пароля
+    QSet<QString> m_restoringNames;  // Профили, которые ещё восстанавливаются
+    int m_pendingRestores = 0;
+    QThread *m_compareThread = nullptr;        // Не nullptr, пока идёт сравнение
+    ResultComparator *m_comparator = nullptr;
 
     Ui::MainWindow *ui;
     DatabaseManager *dbManager;
@@ -0,0 +1,622 @@
+#include "ResultComparator.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMultiHash>
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlDatabase>
+#include <QSqlField>
+#include <QTemporaryDir>
+
+namespace {
+
+const QChar KeySeparator(0x1F);
+const QChar NullKeyMarker(0x1E);    // NULL в ключе, отличается от пустой строки
+const size_t KeySeed = 0x9e3779b9;
+const size_t RowSeed = 0x85ebca6b;
+const qint64 ProgressInterval = 10000;
+const int SplitFactor = 16;
+const int MaxSplitLevel = 3;        // Дальше дробить бессмысленно: один и тот же ключ
+const int InMemoryFactor = 4;       // Ключ в UTF-16, два QByteArray и узел хэша на строку
+
+// Сравниваемое и исходное (для показа) представление строки;
+// raw пуст, если нормализация ничего не изменила
+struct StoredRow
+{
+    QByteArray row;
+    QByteArray raw;
+};
+
+// Удаляет клон соединения; объявляется раньше Side, чтобы запросы
+// были уничтожены до removeDatabase
+struct ConnectionGuard
+{
+    QString name;
+    ~ConnectionGuard() { QSqlDatabase::removeDatabase(name); }
+};
+
+// Доли секунды без хвостовых нулей, как и в normalizeText
+QString timeText(const QTime &time)
+{
+    QString text = time.toString("HH:mm:ss.zzz");
+    while (text.endsWith('0')) text.chop(1);
+    if (text.endsWith('.')) text.chop(1);
+    return text;
+}
+
+// Приводит текст к тому виду, который даёт normalizeValue для типизированных значений
+QString normalizeText(const QString &text)
+{
+    static const QRegularExpression decimal("^-?\\d+\\.\\d+$");
+    static const QRegularExpression dateTime(
+        "^(\\d{4}-\\d{2}-\\d{2})[T ](\\d{2}:\\d{2}:\\d{2})(\\.\\d+)?$");
+
+    if (decimal.match(text).hasMatch()) {
+        QString result = text;
+        while (result.endsWith('0')) result.chop(1);
+        if (result.endsWith('.')) result.chop(1);
+        return result;
+    }
+
+    QRegularExpressionMatch match = dateTime.match(text);
+    if (match.hasMatch()) {
+        QString fraction = match.captured(3);
+        while (fraction.endsWith('0')) fraction.chop(1);
+        if (fraction == ".") fraction.clear();
+        return match.captured(1) + ' ' + match.captured(2) + fraction;
+    }
+
+    return text;
+}
+
+QVariant rawValue(const QVariant &value)
+{
+    if (value.isNull()) return QVariant();
+    if (value.metaType().id() == QMetaType::QByteArray) {
+        return QString::fromLatin1(value.toByteArray().toHex());
+    }
+    return value.toString();
+}
+
+// Одинаковые данные из SQLite и PostgreSQL приходят разными типами, поэтому
+// значения колонки, типы которой на сторонах различаются, сводятся к общему виду
+QVariant normalizeValue(const QVariant &value)
+{
+    if (value.isNull()) return QVariant();
+
+    switch (value.metaType().id()) {
+    case QMetaType::Bool:
+        return QString(value.toBool() ? "1" : "0");
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return QString::number(value.toDouble(), 'g', 15);
+    case QMetaType::QDate:
+        return value.toDate().toString("yyyy-MM-dd");
+    case QMetaType::QTime:
+        return timeText(value.toTime());
+    case QMetaType::QDateTime: {
+        QDateTime dateTime = value.toDateTime();
+        return dateTime.date().toString("yyyy-MM-dd") + ' ' + timeText(dateTime.time());
+    }
+    case QMetaType::QByteArray:
+        return QString::fromLatin1(value.toByteArray().toHex());
+    case QMetaType::QString:
+        return normalizeText(value.toString());
+    default:
+        return value.toString();
+    }
+}
+
+QString rowKey(const QVariantList &values, const QVector<int> &keyPositions)
+{
+    QStringList parts;
+    for (int position : keyPositions) {
+        const QVariant &value = values.at(position);
+        parts << (value.isValid() ? value.toString() : QString(NullKeyMarker));
+    }
+    return parts.join(KeySeparator);
+}
+
+// Строка хранится в компактном виде: флаг NULL и UTF-8 на каждое значение
+QByteArray encodeRow(const QVariantList &values)
+{
+    QByteArray row;
+    QDataStream out(&row, QIODevice::WriteOnly);
+    for (const QVariant &value : values) {
+        if (value.isValid()) {
+            out << quint8(1) << value.toString().toUtf8();
+        } else {
+            out << quint8(0);
+        }
+    }
+    return row;
+}
+
+QVariantList decodeRow(const QByteArray &row)
+{
+    QVariantList values;
+    QDataStream in(row);
+    while (!in.atEnd()) {
+        quint8 present = 0;
+        in >> present;
+        if (present) {
+            QByteArray text;
+            in >> text;
+            values << QString::fromUtf8(text);
+        } else {
+            values << QVariant();
+        }
+    }
+    return values;
+}
+
+// Порядок строк внутри корзины не важен, поэтому суммы строк складываются
+quint64 rowChecksum(const QString &key, const QByteArray &row)
+{
+    return qHash(row, qHash(key, RowSeed));
+}
+
+int columnPosition(const QStringList &columns, const QString &name)
+{
+    for (int i = 0; i < columns.size(); ++i) {
+        if (columns.at(i).compare(name, Qt::CaseInsensitive) == 0) return i;
+    }
+    return -1;
+}
+
+} // namespace
+
+struct ResultComparator::Side
+{
+    QSqlQuery query;
+    QVector<int> fieldIndex;    // Индекс в записи результата для каждой общей колонки
+    QVector<bool> normalize;    // Типы колонки на сторонах различаются
+    QVector<QFile *> files;     // Временный файл на каждую корзину
+    QVector<quint64> checksums;
+    QVector<qint64> counts;
+    QDataStream out;
+    qint64 rows = 0;
+    bool finished = false;
+
+    ~Side() { qDeleteAll(files); }
+};
+
+ResultComparator::ResultComparator(QObject *parent) : QObject(parent)
+{
+}
+
+void ResultComparator::setBucketCount(int count)
+{
+    if (count > 0) m_bucketCount = count;
+}
+
+void ResultComparator::setMaxDifferences(int count)
+{
+    if (count >= 0) m_maxDifferences = count;
+}
+
+void ResultComparator::setBucketMemoryLimit(qint64 bytes)
+{
+    if (bytes > 0) m_bucketMemoryLimit = bytes;
+}
+
+void ResultComparator::run(const QString &leftQuery, const QString &leftConnection,
+                           const QString &rightQuery, const QString &rightConnection,
+                           const QStringList &keyColumns)
+{
+    CompareResult result;
+    bool success = compare(leftQuery, leftConnection, rightQuery, rightConnection,
+                           keyColumns, result);
+    emit finished(success, result, success ? QString() : m_lastError);
+}
+
+void ResultComparator::cancel()
+{
+    m_cancelled = true;
+}
+
+bool ResultComparator::isCancelled() const
+{
+    return m_cancelled;
+}
+
+bool ResultComparator::compare(const QString &leftQuery, const QString &leftConnection,
+                               const QString &rightQuery, const QString &rightConnection,
+                               const QStringList &keyColumns, CompareResult &result)
+{
+    result = CompareResult();
+
+    if (keyColumns.isEmpty()) {
+        m_lastError = "Key columns are not specified";
+        return false;
+    }
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        m_lastError = "Failed to create temporary directory";
+        return false;
+    }
+
+    const QString clonePrefix = QString("compare_%1_").arg(quintptr(this), 0, 16);
+    ConnectionGuard leftGuard{clonePrefix + "left"};
+    ConnectionGuard rightGuard{clonePrefix + "right"};
+
+    Side left;
+    Side right;
+    if (!openSide(left, leftQuery, leftConnection, leftGuard.name, directory.path(), "left")
+        || !openSide(right, rightQuery, rightConnection, rightGuard.name, directory.path(), "right")) {
+        return false;
+    }
+
+    // Общие колонки в порядке левого результата
+    const QSqlRecord leftRecord = left.query.record();
+    const QSqlRecord rightRecord = right.query.record();
+    for (int i = 0; i < leftRecord.count(); ++i) {
+        const int rightIndex = rightRecord.indexOf(leftRecord.fieldName(i));
+        if (rightIndex < 0) {
+            result.leftOnlyColumns << leftRecord.fieldName(i);
+            continue;
+        }
+        result.columns << leftRecord.fieldName(i);
+        left.fieldIndex << i;
+        right.fieldIndex << rightIndex;
+
+        // Текст нормализуется только при разных типах, иначе скрылись бы
+        // настоящие различия вроде '1.10' и '1.1' в текстовой колонке
+        bool normalize = leftRecord.field(i).metaType() != rightRecord.field(rightIndex).metaType();
+        left.normalize << normalize;
+        right.normalize << normalize;
+    }
+    for (int i = 0; i < rightRecord.count(); ++i) {
+        if (leftRecord.indexOf(rightRecord.fieldName(i)) < 0) {
+            result.rightOnlyColumns << rightRecord.fieldName(i);
+        }
+    }
+
+    QVector<int> keyPositions;
+    for (const QString &keyColumn : keyColumns) {
+        const int position = columnPosition(result.columns, keyColumn);
+        if (position < 0) {
+            m_lastError = "Key column not found in both results: " + keyColumn;
+            return false;
+        }
+        keyPositions << position;
+    }
+
+    // Стороны читаются поочерёдно, каждая ровно один раз
+    qint64 reported = 0;
+    while (!left.finished || !right.finished) {
+        if (!left.finished) left.finished = !partitionRow(left, keyPositions);
+        if (!right.finished) right.finished = !partitionRow(right, keyPositions);
+
+        if (left.rows + right.rows - reported >= ProgressInterval) {
+            reported = left.rows + right.rows;
+            emit progress(left.rows, right.rows);
+        }
+        if (m_cancelled) {
+            m_lastError = "Comparison cancelled";
+            return false;
+        }
+    }
+
+    for (Side *side : {&left, &right}) {
+        if (side->query.lastError().isValid()) {
+            m_lastError = side->query.lastError().text();
+            return false;
+        }
+        for (QFile *file : side->files) {
+            file->close();
+            if (file->error() != QFileDevice::NoError) {
+                m_lastError = "Failed to write temporary file: " + file->errorString();
+                return false;
+            }
+        }
+    }
+
+    result.leftRows = left.rows;
+    result.rightRows = right.rows;
+    emit progress(left.rows, right.rows);
+
+    for (int bucket = 0; bucket < m_bucketCount; ++bucket) {
+        if (left.counts[bucket] == right.counts[bucket]
+            && left.checksums[bucket] == right.checksums[bucket]) {
+            ++result.bucketsSkipped;
+        } else {
+            ++result.bucketsCompared;
+            if (!compareFiles(left.files[bucket]->fileName(), right.files[bucket]->fileName(),
+                              0, result.columns, result)) {
+                return false;
+            }
+        }
+        emit bucketProgress(bucket + 1, m_bucketCount);
+    }
+
+    return true;
+}
+
+QString ResultComparator::lastError() const
+{
+    return m_lastError;
+}
+
+bool ResultComparator::openSide(Side &side, const QString &query, const QString &connectionName,
+                                const QString &cloneName, const QString &directory,
+                                const QString &prefix)
+{
+    // Своё соединение на каждую сторону: QSqlDatabase привязан к потоку,
+    // а libpq потоково читает только один результат на соединение
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(connectionName, cloneName);
+        if (!db.isValid()) {
+            m_lastError = "Connection not found: " + connectionName;
+            return false;
+        }
+        if (!db.open()) {
+            m_lastError = db.lastError().text();
+            return false;
+        }
+        side.query = QSqlQuery(db);
+    }
+
+    side.query.setForwardOnly(true);
+    if (!side.query.exec(query)) {
+        m_lastError = side.query.lastError().text();
+        return false;
+    }
+    if (!side.query.isSelect()) {
+        m_lastError = "Query does not return rows: " + query;
+        return false;
+    }
+
+    side.checksums.fill(0, m_bucketCount);
+    side.counts.fill(0, m_bucketCount);
+    for (int bucket = 0; bucket < m_bucketCount; ++bucket) {
+        QFile *file = new QFile(QDir(directory).filePath(QString("%1_%2.bin").arg(prefix).arg(bucket)));
+        side.files << file;
+        if (!file->open(QIODevice::WriteOnly)) {
+            m_lastError = "Failed to create temporary file: " + file->errorString();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ResultComparator::partitionRow(Side &side, const QVector<int> &keyPositions)
+{
+    if (!side.query.next()) return false;
+
+    QVariantList values;
+    QVariantList rawValues;
+    bool normalized = false;
+    values.reserve(side.fieldIndex.size());
+    rawValues.reserve(side.fieldIndex.size());
+    for (int i = 0; i < side.fieldIndex.size(); ++i) {
+        const QVariant value = side.query.value(side.fieldIndex[i]);
+        const QVariant raw = rawValue(value);
+        const QVariant comparable = side.normalize[i] ? normalizeValue(value) : raw;
+        if (comparable != raw) normalized = true;
+        values << comparable;
+        rawValues << raw;
+    }
+
+    const QString key = rowKey(values, keyPositions);
+    const QByteArray row = encodeRow(values);
+    const QByteArray raw = normalized ? encodeRow(rawValues) : QByteArray();
+    const int bucket = int(qHash(key, KeySeed) % size_t(m_bucketCount));
+
+    side.checksums[bucket] += rowChecksum(key, row);
+    ++side.counts[bucket];
+    ++side.rows;
+
+    side.out.setDevice(side.files[bucket]);
+    side.out << key << row << raw;
+    return true;
+}
+
+bool ResultComparator::compareFiles(const QString &leftPath, const QString &rightPath, int level,
+                                    const QStringList &columns, CompareResult &result)
+{
+    if (m_cancelled) {
+        m_lastError = "Comparison cancelled";
+        return false;
+    }
+
+    // В памяти держится только левая сторона, правая читается потоком
+    qint64 leftSize = QFileInfo(leftPath).size();
+    if (leftSize * InMemoryFactor <= m_bucketMemoryLimit) {
+        return diffFiles(leftPath, rightPath, columns, result);
+    }
+    if (level >= MaxSplitLevel) {
+        result.warnings << QString("A bucket of %1 MB exceeds the memory limit after "
+                                   "re-partitioning (many rows share a key)")
+                               .arg(leftSize / (1024 * 1024));
+        return diffFiles(leftPath, rightPath, columns, result);
+    }
+
+    // Корзина не помещается в память: дробим обе стороны с другим seed
+    QVector<QString> leftParts, rightParts;
+    QVector<quint64> leftChecksums, rightChecksums;
+    QVector<qint64> leftCounts, rightCounts;
+    if (!splitFile(leftPath, level, leftParts, leftChecksums, leftCounts)
+        || !splitFile(rightPath, level, rightParts, rightChecksums, rightCounts)) {
+        return false;
+    }
+
+    bool success = true;
+    for (int part = 0; part < SplitFactor && success; ++part) {
+        if (leftCounts[part] != rightCounts[part] || leftChecksums[part] != rightChecksums[part]) {
+            success = compareFiles(leftParts[part], rightParts[part], level + 1, columns, result);
+        }
+    }
+
+    for (const QString &path : leftParts + rightParts) {
+        QFile::remove(path);
+    }
+    return success;
+}
+
+bool ResultComparator::splitFile(const QString &path, int level, QVector<QString> &paths,
+                                 QVector<quint64> &checksums, QVector<qint64> &counts)
+{
+    QFile input(path);
+    if (!input.open(QIODevice::ReadOnly)) {
+        m_lastError = "Failed to read temporary file: " + input.errorString();
+        return false;
+    }
+
+    QVector<QFile *> outputs;
+    paths.clear();
+    checksums.fill(0, SplitFactor);
+    counts.fill(0, SplitFactor);
+    bool success = true;
+    for (int part = 0; part < SplitFactor && success; ++part) {
+        QFile *file = new QFile(QString("%1.%2").arg(path).arg(part));
+        outputs << file;
+        paths << file->fileName();
+        if (!file->open(QIODevice::WriteOnly)) {
+            m_lastError = "Failed to create temporary file: " + file->errorString();
+            success = false;
+        }
+    }
+
+    const size_t seed = KeySeed + size_t(level) + 1;
+    QDataStream in(&input);
+    QDataStream out;
+    QString key;
+    QByteArray row;
+    QByteArray raw;
+    while (success && !in.atEnd()) {
+        if (m_cancelled) {
+            m_lastError = "Comparison cancelled";
+            success = false;
+            break;
+        }
+
+        in >> key >> row >> raw;
+        if (in.status() != QDataStream::Ok) {
+            m_lastError = "Failed to read temporary file: " + path;
+            success = false;
+            break;
+        }
+
+        const int part = int(qHash(key, seed) % size_t(SplitFactor));
+        checksums[part] += rowChecksum(key, row);
+        ++counts[part];
+        out.setDevice(outputs[part]);
+        out << key << row << raw;
+    }
+
+    for (QFile *file : outputs) {
+        file->close();
+        if (success && file->error() != QFileDevice::NoError) {
+            m_lastError = "Failed to write temporary file: " + file->errorString();
+            success = false;
+        }
+    }
+    qDeleteAll(outputs);
+    return success;
+}
+
+bool ResultComparator::diffFiles(const QString &leftPath, const QString &rightPath,
+                                 const QStringList &columns, CompareResult &result)
+{
+    QMultiHash<QString, StoredRow> leftRows;
+    QString key;
+    StoredRow stored;
+
+    QFile leftFile(leftPath);
+    if (!leftFile.open(QIODevice::ReadOnly)) {
+        m_lastError = "Failed to read temporary file: " + leftFile.errorString();
+        return false;
+    }
+    QDataStream leftIn(&leftFile);
+    while (!leftIn.atEnd()) {
+        if (m_cancelled) {
+            m_lastError = "Comparison cancelled";
+            return false;
+        }
+        leftIn >> key >> stored.row >> stored.raw;
+        if (leftIn.status() != QDataStream::Ok) {
+            m_lastError = "Failed to read temporary file: " + leftPath;
+            return false;
+        }
+        leftRows.insert(key, stored);
+    }
+
+    // Для показа берутся исходные значения, а не нормализованные
+    auto displayRow = [](const StoredRow &row) {
+        return decodeRow(row.raw.isEmpty() ? row.row : row.raw);
+    };
+
+    QFile rightFile(rightPath);
+    if (!rightFile.open(QIODevice::ReadOnly)) {
+        m_lastError = "Failed to read temporary file: " + rightFile.errorString();
+        return false;
+    }
+    QDataStream rightIn(&rightFile);
+    while (!rightIn.atEnd()) {
+        if (m_cancelled) {
+            m_lastError = "Comparison cancelled";
+            return false;
+        }
+        rightIn >> key >> stored.row >> stored.raw;
+        if (rightIn.status() != QDataStream::Ok) {
+            m_lastError = "Failed to read temporary file: " + rightPath;
+            return false;
+        }
+
+        auto match = leftRows.find(key);
+        if (match == leftRows.end()) {
+            addDifference(result, {RowDifference::Added, key, {}, {}, displayRow(stored)});
+            continue;
+        }
+
+        // При повторяющихся ключах сначала ищем точное совпадение
+        for (auto it = match; it != leftRows.end() && it.key() == key; ++it) {
+            if (it.value().row == stored.row) {
+                match = it;
+                break;
+            }
+        }
+
+        if (match.value().row != stored.row) {
+            const QVariantList leftValues = decodeRow(match.value().row);
+            const QVariantList rightValues = decodeRow(stored.row);
+            RowDifference difference{RowDifference::Changed, key, {},
+                                     displayRow(match.value()), displayRow(stored)};
+            for (int i = 0; i < columns.size(); ++i) {
+                if (leftValues.at(i) != rightValues.at(i)) difference.columns << columns.at(i);
+            }
+            addDifference(result, std::move(difference));
+        }
+        leftRows.erase(match);
+    }
+
+    for (auto it = leftRows.cbegin(); it != leftRows.cend(); ++it) {
+        addDifference(result, {RowDifference::Removed, it.key(), {}, displayRow(it.value()), {}});
+    }
+    return true;
+}
+
+void ResultComparator::addDifference(CompareResult &result, RowDifference &&difference)
+{
+    switch (difference.kind) {
+    case RowDifference::Added: ++result.added; break;
+    case RowDifference::Removed: ++result.removed; break;
+    case RowDifference::Changed: ++result.changed; break;
+    }
+
+    if (result.differences.size() >= m_maxDifferences) {
+        result.truncated = true;
+        return;
+    }
+
+    difference.key.replace(KeySeparator, QLatin1String(", "));
+    difference.key.replace(NullKeyMarker, QLatin1String("NULL"));
+    result.differences.append(std::move(difference));
+}
@@ -0,0 +1,96 @@
+#ifndef RESULTCOMPARATOR_H
+#define RESULTCOMPARATOR_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVariantList>
+#include <atomic>
+
+struct RowDifference
+{
+    enum Kind { Added, Removed, Changed };
+
+    Kind kind;
+    QString key;
+    QStringList columns;        // Колонки, значения которых отличаются (для Changed)
+    QVariantList leftValues;
+    QVariantList rightValues;
+};
+
+struct CompareResult
+{
+    QStringList columns;        // Общие колонки, по которым идёт сравнение
+    QStringList leftOnlyColumns;
+    QStringList rightOnlyColumns;
+    QList<RowDifference> differences;
+    qint64 leftRows = 0;
+    qint64 rightRows = 0;
+    qint64 added = 0;
+    qint64 removed = 0;
+    qint64 changed = 0;
+    int bucketsSkipped = 0;     // Совпали по контрольной сумме
+    int bucketsCompared = 0;
+    bool truncated = false;     // differences обрезан по maxDifferences
+    QStringList warnings;
+};
+Q_DECLARE_METATYPE(CompareResult)
+
+// Сравнение двух результатов запросов (в т.ч. на разных соединениях).
+// Строки раскладываются по корзинам по хэшу ключа и сбрасываются во временные
+// файлы; корзины с одинаковой контрольной суммой пропускаются, остальные
+// сравниваются построчно. Корзина, файл которой больше лимита памяти,
+// перед загрузкой дробится заново с другим seed.
+// Предназначен для работы в отдельном потоке: каждая сторона читается
+// через собственный клон соединения (QSqlDatabase::cloneDatabase).
+class ResultComparator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ResultComparator(QObject *parent = nullptr);
+
+    void setBucketCount(int count);
+    void setMaxDifferences(int count);
+    void setBucketMemoryLimit(qint64 bytes);
+
+    bool compare(const QString &leftQuery, const QString &leftConnection,
+                 const QString &rightQuery, const QString &rightConnection,
+                 const QStringList &keyColumns, CompareResult &result);
+
+    QString lastError() const;
+
+    // Потокобезопасны: вызываются из потока окна во время compare()
+    void cancel();
+    bool isCancelled() const;
+
+public slots:
+    void run(const QString &leftQuery, const QString &leftConnection,
+             const QString &rightQuery, const QString &rightConnection,
+             const QStringList &keyColumns);
+
+signals:
+    void progress(qint64 leftRows, qint64 rightRows);
+    void bucketProgress(int done, int total);
+    void finished(bool success, const CompareResult &result, const QString &error);
+
+private:
+    struct Side;
+
+    bool openSide(Side &side, const QString &query, const QString &connectionName,
+                  const QString &cloneName, const QString &directory, const QString &prefix);
+    bool partitionRow(Side &side, const QVector<int> &keyPositions);
+    bool compareFiles(const QString &leftPath, const QString &rightPath, int level,
+                      const QStringList &columns, CompareResult &result);
+    bool splitFile(const QString &path, int level, QVector<QString> &paths,
+                   QVector<quint64> &checksums, QVector<qint64> &counts);
+    bool diffFiles(const QString &leftPath, const QString &rightPath,
+                   const QStringList &columns, CompareResult &result);
+    void addDifference(CompareResult &result, RowDifference &&difference);
+
+    int m_bucketCount = 64;
+    int m_maxDifferences = 1000;
+    qint64 m_bucketMemoryLimit = 64 * 1024 * 1024;
+    std::atomic<bool> m_cancelled{false};
+    QString m_lastError;
+};
+
+#endif // RESULTCOMPARATOR_H
@@ -0,0 +1,117 @@
+#include "SessionRestorer.h"
+#include <QFileInfo>
+#include <QSettings>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QThread>
+
+// Без QSqlDatabase::moveToThread окну пришлось бы подключаться заново
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+#error "Session restore requires Qt 6.8 or later (QSqlDatabase::moveToThread)"
+#endif
+
+SessionRestorer::SessionRestorer(QObject *parent)
+    : QObject(parent), m_targetThread(QThread::currentThread())
+{
+}
+
+QList<ConnectionProfile> SessionRestorer::loadProfiles()
+{
+    QList<ConnectionProfile> profiles;
+    QSettings settings;
+    int count = settings.beginReadArray("connections");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        ConnectionProfile profile;
+        profile.type = settings.value("type").toString() == "PostgreSQL" ?
+                       DatabaseManager::PostgreSQL : DatabaseManager::SQLite;
+        profile.name = settings.value("name").toString();
+        profile.databaseName = settings.value("database").toString();
+        profile.host = settings.value("host").toString();
+        profile.user = settings.value("user").toString();
+        profile.port = settings.value("port", -1).toInt();
+        profile.needsPassword = settings.value("needsPassword", false).toBool();
+        profiles << profile;
+    }
+    settings.endArray();
+    return profiles;
+}
+
+void SessionRestorer::saveProfiles(const QList<ConnectionProfile> &profiles)
+{
+    QSettings settings;
+    settings.beginWriteArray("connections", profiles.size());
+    for (int i = 0; i < profiles.size(); ++i) {
+        const ConnectionProfile &profile = profiles.at(i);
+        settings.setArrayIndex(i);
+        settings.setValue("type", profile.type == DatabaseManager::PostgreSQL ? "PostgreSQL" : "SQLite");
+        settings.setValue("name", profile.name);
+        settings.setValue("database", profile.databaseName);
+        settings.setValue("host", profile.host);
+        settings.setValue("user", profile.user);
+        settings.setValue("port", profile.port);
+        settings.setValue("needsPassword", profile.needsPassword);
+    }
+    settings.endArray();
+}
+
+void SessionRestorer::run()
+{
+    {
+        QSettings settings;
+        emit historyLoaded(settings.value("queryHistory").toStringList());
+    }
+
+    // Какие профили открывать, решает окно: только оно знает занятые имена
+    emit profilesLoaded(loadProfiles());
+}
+
+void SessionRestorer::openProfile(const ConnectionProfile &profile, const QString &password)
+{
+    // Окно закрывается: новые подключения не начинаем
+    if (QThread::currentThread()->isInterruptionRequested()) return;
+
+    if (profile.type == DatabaseManager::SQLite && !QFileInfo::exists(profile.databaseName)) {
+        emit profileRestored(profile, false, QStringList(), "Database file does not exist");
+        return;
+    }
+
+    QString driver = DatabaseManager::driverName(profile.type);
+    if (!QSqlDatabase::isDriverAvailable(driver)) {
+        emit profileRestored(profile, false, QStringList(), "Driver not available: " + driver);
+        return;
+    }
+
+    bool success = false;
+    QStringList tables;
+    QString error;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(driver, profile.name);
+        db.setDatabaseName(profile.databaseName);
+        if (profile.type == DatabaseManager::PostgreSQL) {
+            db.setHostName(profile.host);
+            db.setUserName(profile.user);
+            db.setPassword(password);
+            if (profile.port > 0) db.setPort(profile.port);
+            db.setConnectOptions(DatabaseManager::postgreSQLConnectOptions());
+        }
+
+        success = db.open();
+        if (!success) {
+            error = db.lastError().text();
+        } else if (QThread::currentThread()->isInterruptionRequested()) {
+            success = false;
+            db.close();
+        } else {
+            tables = db.tables(QSql::Tables);
+            success = db.moveToThread(m_targetThread);
+            if (!success) {
+                error = "Failed to hand over connection";
+                db.close();
+            }
+        }
+    }
+    if (!success) QSqlDatabase::removeDatabase(profile.name);
+
+    emit profileRestored(profile, success, tables, error);
+}
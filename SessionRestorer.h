@@ -0,0 +1,49 @@
+#ifndef SESSIONRESTORER_H
+#define SESSIONRESTORER_H
+
+#include <QObject>
+#include <QStringList>
+#include "DatabaseManager.h"
+
+class QThread;
+
+// Сохранённые параметры подключения (пароль не сохраняется)
+struct ConnectionProfile
+{
+    DatabaseManager::DatabaseType type = DatabaseManager::SQLite;
+    QString name;
+    QString databaseName;
+    QString host;
+    QString user;
+    int port = -1;
+    bool needsPassword = false;  // Пароль запрашивается у пользователя при восстановлении
+};
+Q_DECLARE_METATYPE(ConnectionProfile)
+
+// Восстановление сессии в фоновом потоке: читает историю и профили
+// из QSettings и открывает подключения, которые запрашивает окно.
+// Открытое соединение передаётся потоку окна через QSqlDatabase::moveToThread.
+class SessionRestorer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SessionRestorer(QObject *parent = nullptr);
+
+    static QList<ConnectionProfile> loadProfiles();
+    static void saveProfiles(const QList<ConnectionProfile> &profiles);
+
+public slots:
+    void run();
+    void openProfile(const ConnectionProfile &profile, const QString &password);
+
+signals:
+    void historyLoaded(const QStringList &history);
+    void profilesLoaded(const QList<ConnectionProfile> &profiles);
+    void profileRestored(const ConnectionProfile &profile, bool success,
+                         const QStringList &tables, const QString &error);
+
+private:
+    QThread *m_targetThread;    // Поток окна, которому передаются соединения
+};
+
+#endif // SESSIONRESTORER_H
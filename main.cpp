@@ -1,17 +1,28 @@
 #include "MainWindow.h"
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+
+// Целевое время от запуска до первой отрисовки окна
+static const qint64 FirstPaintTargetMs = 500;
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     QApplication a(argc, argv);
     
-    // Проверка доступности драйверов БД
-    qDebug() << "Available database drivers:";
-    for(const QString &driver : QSqlDatabase::drivers())
-        qDebug() << "  " << driver;
-
+    // Драйверы БД больше не перечисляются при старте:
+    // наличие драйвера проверяется при подключении
     MainWindow w;
+    QObject::connect(&w, &MainWindow::firstPainted, [&startupTimer]() {
+        qint64 elapsed = startupTimer.elapsed();
+        qDebug() << "Time to first paint:" << elapsed << "ms";
+        if (elapsed > FirstPaintTargetMs)
+            qWarning() << "Time to first paint exceeds target of" << FirstPaintTargetMs << "ms";
+    });
     w.show();
     
     return a.exec();
-}
\ No newline at end of file
+}